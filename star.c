@@ -1,3 +1,4 @@
+#define _GNU_SOURCE  // O_DIRECT y sync_file_range
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,8 +6,11 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <fnmatch.h>
 
 #define BLOCK_SIZE (256 * 1024)  // 256K
+#define IO_ALIGN 4096            // Alineación exigida por O_DIRECT
 #define MAX_FILES 250
 #define MAX_PATH 256
 
@@ -24,6 +28,15 @@ struct FileEntry {
     int is_used;
 };
 
+// Índice de nombres ordenado, guardado justo después de la tabla de archivos.
+// Permite seleccionar por prefijo o patrón con búsqueda binaria
+struct NameIndex {
+    int count;
+    int slots[MAX_FILES];  // Posiciones en file_table, ordenadas por nombre
+};
+
+#define NAME_INDEX_OFFSET (sizeof(struct StarHeader) + sizeof(struct FileEntry) * MAX_FILES)
+
 // Estructura para el bloque de datos
 struct Block {
     int next_block;
@@ -34,18 +47,443 @@ struct Block {
 struct StarFile {
     struct StarHeader header;
     struct FileEntry file_table[MAX_FILES];
+    struct NameIndex name_index;
+    char table_loaded;  // 0 si las entradas se leen del disco a medida que se usan
     int fd;  // File descriptor
     char verbose;
+    char direct_io;   // 0: normal, 1: O_DIRECT en el archivo star, 2: también en origen/destino
+    int data_fd;      // Descriptor para los bloques de datos
+    int data_direct;  // 1 si data_fd quedó abierto con O_DIRECT
+};
+
+// Flujo secuencial sobre un archivo de origen o destino en modo directo
+struct BulkStream {
+    int fd;
+    int direct;       // 1 si fd usa O_DIRECT
+    char drop_cache;  // Descartar del page cache lo ya procesado
+    char *buf;        // Buffer alineado de 2 * BLOCK_SIZE (solo si se abrió con O_DIRECT)
+    size_t start;     // Inicio de los datos pendientes en buf
+    size_t len;       // Bytes pendientes en buf
+    off_t offset;     // Posición en el archivo de la próxima E/S
 };
 
+// Abre un archivo para E/S masiva. Si se pide O_DIRECT y el sistema de
+// archivos no lo admite, se abre normal y *direct queda en 0
+int open_bulk(const char *path, int flags, mode_t mode, int want_direct, int *direct) {
+    *direct = 0;
+    if (want_direct) {
+        int fd = open(path, flags | O_DIRECT, mode);
+        if (fd != -1) {
+            *direct = 1;
+            return fd;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+    }
+    int fd = open(path, flags, mode);
+    if (fd != -1 && want_direct) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    return fd;
+}
+
+// Descarta del page cache un rango ya procesado. Las páginas sucias se
+// escriben primero, porque DONTNEED no libera páginas pendientes de escritura
+void drop_cache(int fd, off_t offset, off_t len, int dirty) {
+    if (dirty) {
+        sync_file_range(fd, offset, len, SYNC_FILE_RANGE_WAIT_BEFORE |
+                        SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    }
+    posix_fadvise(fd, offset, len, POSIX_FADV_DONTNEED);
+}
+
+// pread/pwrite posicional. Si el kernel rechaza O_DIRECT al hacer la E/S,
+// se quita O_DIRECT del descriptor y se reintenta en modo normal
+ssize_t bulk_pio(int fd, int *direct, void *buf, size_t len, off_t offset, int writing) {
+    ssize_t n = writing ? pwrite(fd, buf, len, offset) : pread(fd, buf, len, offset);
+    if (n == -1 && errno == EINVAL && *direct) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        *direct = 0;
+        n = writing ? pwrite(fd, buf, len, offset) : pread(fd, buf, len, offset);
+    }
+    return n;
+}
+
+// Reserva un bloque alineado para poder usarlo con O_DIRECT
+struct Block *alloc_block(void) {
+    void *block;
+    if (posix_memalign(&block, IO_ALIGN, sizeof(struct Block)) != 0) {
+        fprintf(stderr, "Error allocating block buffer\n");
+        return NULL;
+    }
+    return block;
+}
+
+// Lee o escribe un bloque completo del archivo star
+ssize_t block_io(int fd, int *direct, char direct_io, struct Block *block, int index, int writing) {
+    off_t offset = (off_t)index * sizeof(struct Block);
+    ssize_t n = bulk_pio(fd, direct, block, sizeof(struct Block), offset, writing);
+    if (n > 0 && direct_io && !*direct) {
+        drop_cache(fd, offset, n, writing);
+    }
+    return n;
+}
+
+// Obtiene un bloque libre: primero de la lista de libres y si no, al final
+// del archivo. *end_block lleva la cuenta de los bloques ya tomados al final
+int allocate_block(struct StarFile *star, int *end_block) {
+    int block = star->header.first_free_block;
+    if (block == -1) {
+        return (*end_block)++;
+    }
+    int next;
+    lseek(star->fd, block * sizeof(struct Block), SEEK_SET);
+    read(star->fd, &next, sizeof(int));
+    star->header.first_free_block = next;
+    return block;
+}
+
+// Deshace la última asignación de allocate_block. Un bloque tomado del final
+// (a partir de first_end_block) se devuelve bajando end_block; uno de la
+// lista de libres se vuelve a enlazar al principio de la lista
+void release_block(struct StarFile *star, int *end_block, int first_end_block, int block) {
+    if (block >= first_end_block) {
+        (*end_block)--;
+        return;
+    }
+    int next = star->header.first_free_block;
+    if (pwrite(star->fd, &next, sizeof(int), (off_t)block * sizeof(struct Block)) == sizeof(int)) {
+        star->header.first_free_block = block;
+    }
+}
+
+int stream_open(struct BulkStream *s, const char *path, int flags, mode_t mode, char direct_io) {
+    s->fd = open_bulk(path, flags, mode, direct_io > 1, &s->direct);
+    if (s->fd == -1) {
+        return -1;
+    }
+    s->drop_cache = direct_io > 0;
+    s->buf = NULL;
+    s->start = 0;
+    s->len = 0;
+    s->offset = 0;
+    if (s->direct && posix_memalign((void **)&s->buf, IO_ALIGN, 2 * BLOCK_SIZE) != 0) {
+        fprintf(stderr, "Error allocating stream buffer\n");
+        close(s->fd);
+        return -1;
+    }
+    return 0;
+}
+
+// E/S en la posición actual del flujo, descartando del cache si no hay O_DIRECT
+ssize_t stream_pio(struct BulkStream *s, void *buf, size_t len, int writing) {
+    ssize_t n = bulk_pio(s->fd, &s->direct, buf, len, s->offset, writing);
+    if (n > 0) {
+        if (s->drop_cache && !s->direct) {
+            drop_cache(s->fd, s->offset, n, writing);
+        }
+        s->offset += n;
+    }
+    return n;
+}
+
+// Lee hasta len bytes; devuelve menos solo al llegar al final del archivo
+ssize_t stream_read(struct BulkStream *s, void *dst, size_t len) {
+    if (!s->buf) {
+        return stream_pio(s, dst, len, 0);
+    }
+    while (s->len < len) {
+        // Reubicar lo pendiente para que la próxima lectura caiga alineada
+        size_t aligned = (s->len + IO_ALIGN - 1) & ~(size_t)(IO_ALIGN - 1);
+        memmove(s->buf + aligned - s->len, s->buf + s->start, s->len);
+        s->start = aligned - s->len;
+        ssize_t n = stream_pio(s, s->buf + aligned, BLOCK_SIZE, 0);
+        if (n == -1) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        s->len += n;
+    }
+    size_t taken = (s->len < len) ? s->len : len;
+    memcpy(dst, s->buf + s->start, taken);
+    s->start += taken;
+    s->len -= taken;
+    return taken;
+}
+
+ssize_t stream_write(struct BulkStream *s, const void *src, size_t len) {
+    if (!s->buf) {
+        return stream_pio(s, (void *)src, len, 1);
+    }
+    memcpy(s->buf + s->len, src, len);
+    s->len += len;
+    if (s->len >= BLOCK_SIZE) {
+        if (stream_pio(s, s->buf, BLOCK_SIZE, 1) != BLOCK_SIZE) {
+            return -1;
+        }
+        s->len -= BLOCK_SIZE;
+        memmove(s->buf, s->buf + BLOCK_SIZE, s->len);
+    }
+    return len;
+}
+
+// Cierra el flujo. En escritura directa, la cola que no llena un múltiplo de
+// IO_ALIGN se escribe rellenada con ceros y luego se trunca al tamaño real
+int stream_close(struct BulkStream *s) {
+    int result = 0;
+    if (s->buf && s->len > 0) {
+        off_t size = s->offset + s->len;
+        size_t padded = (s->len + IO_ALIGN - 1) & ~(size_t)(IO_ALIGN - 1);
+        memset(s->buf + s->len, 0, padded - s->len);
+        if (stream_pio(s, s->buf, padded, 1) != (ssize_t)padded ||
+            ftruncate(s->fd, size) == -1) {
+            perror("Error writing file tail");
+            result = -1;
+        }
+    }
+    free(s->buf);
+    close(s->fd);
+    return result;
+}
+
+// Devuelve la entrada de una posición de la tabla. Si la tabla no se cargó
+// completa, lee solo esa entrada del disco
+struct FileEntry *get_entry(struct StarFile *star, int slot) {
+    if (!star->table_loaded) {
+        pread(star->fd, &star->file_table[slot], sizeof(struct FileEntry),
+              sizeof(struct StarHeader) + slot * sizeof(struct FileEntry));
+    }
+    return &star->file_table[slot];
+}
+
+// Primera posición del índice cuyo nombre es mayor o igual que name
+int index_lower_bound(struct StarFile *star, const char *name) {
+    int low = 0;
+    int high = star->name_index.count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (strcmp(get_entry(star, star->name_index.slots[mid])->filename, name) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void index_insert(struct StarFile *star, int slot) {
+    struct NameIndex *index = &star->name_index;
+    int pos = index_lower_bound(star, star->file_table[slot].filename);
+    memmove(&index->slots[pos + 1], &index->slots[pos], (index->count - pos) * sizeof(int));
+    index->slots[pos] = slot;
+    index->count++;
+}
+
+void index_remove(struct StarFile *star, int slot) {
+    struct NameIndex *index = &star->name_index;
+    // Puede haber nombres repetidos: avanzar hasta dar con la posición
+    int pos = index_lower_bound(star, star->file_table[slot].filename);
+    while (pos < index->count && index->slots[pos] != slot) {
+        pos++;
+    }
+    if (pos == index->count) {
+        return;
+    }
+    index->count--;
+    memmove(&index->slots[pos], &index->slots[pos + 1], (index->count - pos) * sizeof(int));
+}
+
+void write_name_index(struct StarFile *star) {
+    lseek(star->fd, NAME_INDEX_OFFSET, SEEK_SET);
+    write(star->fd, &star->name_index, sizeof(struct NameIndex));
+}
+
+// Comprueba que el índice leído del disco se pueda usar: cantidad igual a la
+// del header y posiciones dentro de la tabla, sin repetir y en uso
+int name_index_is_valid(struct StarFile *star) {
+    struct NameIndex *index = &star->name_index;
+    if (index->count < 0 || index->count > MAX_FILES ||
+        index->count != star->header.num_files) {
+        return 0;
+    }
+    
+    char seen[MAX_FILES] = {0};
+    for (int i = 0; i < index->count; i++) {
+        int slot = index->slots[i];
+        if (slot < 0 || slot >= MAX_FILES || seen[slot]) {
+            return 0;
+        }
+        if (star->table_loaded && !star->file_table[slot].is_used) {
+            return 0;
+        }
+        seen[slot] = 1;
+    }
+    return 1;
+}
+
+// Lee el índice de nombres. Si no es válido (por ejemplo, en un archivo
+// creado antes de existir el índice) se reconstruye desde la tabla, y solo
+// se guarda en el disco si la operación modifica el archivo
+void load_name_index(struct StarFile *star, int writable) {
+    lseek(star->fd, NAME_INDEX_OFFSET, SEEK_SET);
+    ssize_t bytes_read = read(star->fd, &star->name_index, sizeof(struct NameIndex));
+    if (bytes_read == sizeof(struct NameIndex) && name_index_is_valid(star)) {
+        return;
+    }
+    
+    if (!star->table_loaded) {
+        lseek(star->fd, sizeof(struct StarHeader), SEEK_SET);
+        read(star->fd, star->file_table, sizeof(struct FileEntry) * MAX_FILES);
+        star->table_loaded = 1;
+    }
+    star->name_index.count = 0;
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (star->file_table[i].is_used) {
+            index_insert(star, i);
+        }
+    }
+    if (writable) {
+        write_name_index(star);
+    }
+}
+
+// Selecciona el nombre exacto y, si es un directorio, todo su contenido.
+// Se recorren en el índice los nombres que empiezan con name
+int find_literal(struct StarFile *star, const char *name, int *matches) {
+    size_t len = strlen(name);
+    int num_matches = 0;
+    for (int pos = index_lower_bound(star, name); pos < star->name_index.count; pos++) {
+        int slot = star->name_index.slots[pos];
+        struct FileEntry *entry = get_entry(star, slot);
+        if (strncmp(entry->filename, name, len) != 0) {
+            break;
+        }
+        if (entry->filename[len] == '\0' || entry->filename[len] == '/') {
+            matches[num_matches++] = slot;
+        }
+    }
+    return num_matches;
+}
+
+// Busca las entradas que coinciden con un nombre o patrón glob. Un nombre
+// presente en el archivo se toma literal aunque tenga caracteres como '['.
+// Si no, se usa como patrón y solo se recorren los nombres que comparten su
+// prefijo literal
+int find_matches(struct StarFile *star, const char *pattern_arg, int *matches) {
+    // Quitar las barras finales: 'logs/2026-10/' equivale a 'logs/2026-10'
+    char pattern[MAX_PATH];
+    strncpy(pattern, pattern_arg, MAX_PATH - 1);
+    pattern[MAX_PATH - 1] = '\0';
+    size_t len = strlen(pattern);
+    while (len > 1 && pattern[len - 1] == '/') {
+        pattern[--len] = '\0';
+    }
+    
+    int num_matches = find_literal(star, pattern, matches);
+    if (num_matches > 0) {
+        return num_matches;
+    }
+    
+    char prefix[MAX_PATH];
+    size_t prefix_len = strcspn(pattern, "*?[\\");
+    memcpy(prefix, pattern, prefix_len);
+    prefix[prefix_len] = '\0';
+    
+    for (int pos = index_lower_bound(star, prefix); pos < star->name_index.count; pos++) {
+        int slot = star->name_index.slots[pos];
+        struct FileEntry *entry = get_entry(star, slot);
+        if (strncmp(entry->filename, prefix, prefix_len) != 0) {
+            break;
+        }
+        if (fnmatch(pattern, entry->filename, FNM_LEADING_DIR) == 0) {
+            matches[num_matches++] = slot;
+        }
+    }
+    return num_matches;
+}
+
+// Junta las entradas que coinciden con cualquiera de los patrones, sin
+// repetir. Avisa de los patrones que no coinciden con ninguna entrada
+int select_files(struct StarFile *star, char **patterns, int num_patterns,
+                 int *selected, int *num_selected) {
+    char seen[MAX_FILES] = {0};
+    int matches[MAX_FILES];
+    int result = 0;
+    
+    *num_selected = 0;
+    for (int p = 0; p < num_patterns; p++) {
+        int num_matches = find_matches(star, patterns[p], matches);
+        if (num_matches == 0) {
+            fprintf(stderr, "File not found: %s\n", patterns[p]);
+            result = -1;
+        }
+        for (int i = 0; i < num_matches; i++) {
+            if (!seen[matches[i]]) {
+                seen[matches[i]] = 1;
+                selected[(*num_selected)++] = matches[i];
+            }
+        }
+    }
+    return result;
+}
+
+// Indica si un nombre tiene componentes '..', que al extraer podrían
+// escribir fuera del directorio actual
+int has_parent_ref(const char *path) {
+    for (const char *p = path; (p = strstr(p, "..")) != NULL; p += 2) {
+        if ((p == path || p[-1] == '/') && (p[2] == '\0' || p[2] == '/')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Crea los directorios intermedios de una ruta extraída. Con rutas absolutas
+// no se crea nada, para no armar directorios fuera del directorio actual
+void make_parent_dirs(const char *path) {
+    if (path[0] == '/') {
+        return;
+    }
+    char dir[MAX_PATH];
+    strncpy(dir, path, MAX_PATH - 1);
+    dir[MAX_PATH - 1] = '\0';
+    for (char *slash = strchr(dir + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+        *slash = '/';
+    }
+}
+
 // Funciones principales
-void init_star_file(struct StarFile *star, const char *filename, char verbose) {
-    star->fd = open(filename, O_RDWR | O_CREAT, 0644);
+void init_star_file(struct StarFile *star, const char *filename, char verbose,
+                    char direct_io, int create) {
+    // Al crear se descarta el contenido anterior, para no dejar bloques muertos
+    star->fd = open(filename, O_RDWR | O_CREAT | (create ? O_TRUNC : 0), 0644);
     if (star->fd == -1) {
         perror("Error opening file");
         exit(1);
     }
     star->verbose = verbose;
+    star->direct_io = direct_io;
+    
+    // Segundo descriptor para los bloques: O_DIRECT exige offsets alineados,
+    // y el header y la tabla no lo están
+    star->data_fd = open_bulk(filename, O_RDWR, 0, direct_io > 0, &star->data_direct);
+    if (star->data_fd == -1) {
+        perror("Error opening file");
+        exit(1);
+    }
+    if (verbose && direct_io && !star->data_direct) {
+        printf("O_DIRECT not supported, using posix_fadvise\n");
+    }
+    
+    // Al abrir un archivo existente se conserva su header y su tabla
+    if (!create) {
+        return;
+    }
     
     // Inicializar header
     star->header.num_files = 0;
@@ -57,6 +495,11 @@ void init_star_file(struct StarFile *star, const char *filename, char verbose) {
     // Inicializar tabla de archivos
     memset(star->file_table, 0, sizeof(struct FileEntry) * MAX_FILES);
     write(star->fd, star->file_table, sizeof(struct FileEntry) * MAX_FILES);
+    star->table_loaded = 1;
+    
+    // Inicializar índice de nombres
+    memset(&star->name_index, 0, sizeof(struct NameIndex));
+    write(star->fd, &star->name_index, sizeof(struct NameIndex));
 }
 
 int add_file(struct StarFile *star, const char *filename) {
@@ -81,58 +524,94 @@ int add_file(struct StarFile *star, const char *filename) {
     }
     
     // Abrir archivo fuente
-    int src_fd = open(filename, O_RDONLY);
-    if (src_fd == -1) {
+    struct BulkStream src;
+    if (stream_open(&src, filename, O_RDONLY, 0, star->direct_io) == -1) {
         perror("Error opening source file");
         return -1;
     }
     
-    // Preparar entrada en la tabla
-    strncpy(star->file_table[file_index].filename, filename, MAX_PATH - 1);
-    star->file_table[file_index].size = st.st_size;
-    star->file_table[file_index].is_used = 1;
+    struct Block *block = alloc_block();
+    if (!block) {
+        stream_close(&src);
+        return -1;
+    }
     
     // Calcular número de bloques necesarios
-    int num_blocks = (st.st_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    struct Block block;
+    int num_blocks = (st.st_size + sizeof(block->data) - 1) / sizeof(block->data);
     
-    // Copiar datos
-    int current_block = star->header.first_free_block;
-    star->file_table[file_index].first_block = current_block;
+    // Los bloques nuevos van después del header y la tabla de archivos
+    off_t end = lseek(star->fd, 0, SEEK_END);
+    int end_block = (end + sizeof(struct Block) - 1) / sizeof(struct Block);
+    int first_end_block = end_block;
+    
+    // Copiar datos. La entrada de la tabla se llena solo si la copia termina bien
+    int first_block = (num_blocks > 0) ? allocate_block(star, &end_block) : -1;
+    int current_block = first_block;
+    int last_written = -1;
     
     for (int i = 0; i < num_blocks; i++) {
         // Leer datos del archivo fuente
-        ssize_t bytes_read = read(src_fd, block.data, sizeof(block.data));
+        ssize_t bytes_read = stream_read(&src, block->data, sizeof(block->data));
         if (bytes_read == -1) {
             perror("Error reading source file");
-            close(src_fd);
-            return -1;
+            break;
         }
         
         // Configurar siguiente bloque
         if (i == num_blocks - 1) {
-            block.next_block = -1;
+            block->next_block = -1;
         } else {
-            block.next_block = current_block + 1;
+            block->next_block = allocate_block(star, &end_block);
         }
         
         // Escribir bloque
-        lseek(star->fd, current_block * sizeof(struct Block), SEEK_SET);
-        write(star->fd, &block, sizeof(struct Block));
+        if (block_io(star->data_fd, &star->data_direct, star->direct_io,
+                     block, current_block, 1) != sizeof(struct Block)) {
+            fprintf(stderr, "Error writing block %d of %s\n", current_block, filename);
+            if (block->next_block != -1) {
+                release_block(star, &end_block, first_end_block, block->next_block);
+            }
+            break;
+        }
         
-        current_block = block.next_block;
+        last_written = current_block;
+        current_block = block->next_block;
     }
     
-    close(src_fd);
+    stream_close(&src);
+    free(block);
+    
+    // Si la copia falló, los bloques tomados vuelven a la lista de libres:
+    // primero el que no llegó a escribirse y luego la cadena ya escrita
+    if (current_block != -1) {
+        release_block(star, &end_block, first_end_block, current_block);
+        int free_head = star->header.first_free_block;
+        if (last_written != -1 &&
+            pwrite(star->fd, &free_head, sizeof(int),
+                   (off_t)last_written * sizeof(struct Block)) == sizeof(int)) {
+            star->header.first_free_block = first_block;
+        }
+        lseek(star->fd, 0, SEEK_SET);
+        write(star->fd, &star->header, sizeof(struct StarHeader));
+        return -1;
+    }
+    
+    // Preparar entrada en la tabla
+    strncpy(star->file_table[file_index].filename, filename, MAX_PATH - 1);
+    star->file_table[file_index].size = st.st_size;
+    star->file_table[file_index].first_block = first_block;
+    star->file_table[file_index].is_used = 1;
+    index_insert(star, file_index);
     
     // Actualizar header
     star->header.num_files++;
     lseek(star->fd, 0, SEEK_SET);
     write(star->fd, &star->header, sizeof(struct StarHeader));
     
-    // Actualizar tabla de archivos
+    // Actualizar tabla de archivos e índice de nombres
     lseek(star->fd, sizeof(struct StarHeader), SEEK_SET);
     write(star->fd, star->file_table, sizeof(struct FileEntry) * MAX_FILES);
+    write_name_index(star);
     
     if (star->verbose) {
         printf("Added file: %s\n", filename);
@@ -141,49 +620,60 @@ int add_file(struct StarFile *star, const char *filename) {
     return 0;
 }
 
-int extract_file(struct StarFile *star, const char *filename) {
-    // Buscar archivo en la tabla
-    int file_index = -1;
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (star->file_table[i].is_used && 
-            strcmp(star->file_table[i].filename, filename) == 0) {
-            file_index = i;
-            break;
-        }
-    }
+int extract_entry(struct StarFile *star, int file_index) {
+    const char *filename = star->file_table[file_index].filename;
     
-    if (file_index == -1) {
-        fprintf(stderr, "File not found: %s\n", filename);
+    if (has_parent_ref(filename)) {
+        fprintf(stderr, "Refusing to extract path with '..': %s\n", filename);
         return -1;
     }
     
     // Abrir archivo destino
-    int dst_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (dst_fd == -1) {
+    make_parent_dirs(filename);
+    struct BulkStream dst;
+    if (stream_open(&dst, filename, O_WRONLY | O_CREAT | O_TRUNC, 0644, star->direct_io) == -1) {
         perror("Error creating destination file");
         return -1;
     }
     
+    struct Block *block = alloc_block();
+    if (!block) {
+        stream_close(&dst);
+        return -1;
+    }
+    
     // Copiar bloques
-    struct Block block;
     int current_block = star->file_table[file_index].first_block;
     size_t remaining = star->file_table[file_index].size;
     
     while (current_block != -1 && remaining > 0) {
         // Leer bloque
-        lseek(star->fd, current_block * sizeof(struct Block), SEEK_SET);
-        read(star->fd, &block, sizeof(struct Block));
+        if (block_io(star->data_fd, &star->data_direct, star->direct_io,
+                     block, current_block, 0) != sizeof(struct Block)) {
+            fprintf(stderr, "Error reading block %d of %s\n", current_block, filename);
+            free(block);
+            stream_close(&dst);
+            return -1;
+        }
         
         // Escribir datos
-        size_t to_write = (remaining > sizeof(block.data)) ? 
-                         sizeof(block.data) : remaining;
-        write(dst_fd, block.data, to_write);
+        size_t to_write = (remaining > sizeof(block->data)) ? 
+                         sizeof(block->data) : remaining;
+        if (stream_write(&dst, block->data, to_write) != (ssize_t)to_write) {
+            fprintf(stderr, "Error writing destination file: %s\n", filename);
+            free(block);
+            stream_close(&dst);
+            return -1;
+        }
         
         remaining -= to_write;
-        current_block = block.next_block;
+        current_block = block->next_block;
     }
     
-    close(dst_fd);
+    free(block);
+    if (stream_close(&dst) == -1) {
+        return -1;
+    }
     
     if (star->verbose) {
         printf("Extracted file: %s\n", filename);
@@ -192,64 +682,71 @@ int extract_file(struct StarFile *star, const char *filename) {
     return 0;
 }
 
+// Extrae los archivos que coinciden con nombres o patrones (ej. 'logs/2026-10/*')
+int extract_files(struct StarFile *star, char **patterns, int num_patterns) {
+    int selected[MAX_FILES];
+    int num_selected;
+    int result = select_files(star, patterns, num_patterns, selected, &num_selected);
+    
+    for (int i = 0; i < num_selected; i++) {
+        if (extract_entry(star, selected[i]) == -1) {
+            result = -1;
+        }
+    }
+    return result;
+}
 
 void extract_all_files(struct StarFile *star) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (star->file_table[i].is_used) {
-            if (star->verbose) {
-                printf("Extracting: %s\n", star->file_table[i].filename);
-            }
-            extract_file(star, star->file_table[i].filename);
+    for (int i = 0; i < star->name_index.count; i++) {
+        int slot = star->name_index.slots[i];
+        if (star->verbose) {
+            printf("Extracting: %s\n", star->file_table[slot].filename);
         }
+        extract_entry(star, slot);
     }
 }
 
-// Función para listar el contenido del archivo
-void list_files(struct StarFile *star) {
-    printf("Contents of archive:\n");
-    printf("%-40s %15s\n", "Filename", "Size");
-    printf("---------------------------------------- ---------------\n");
+void list_entry(struct StarFile *star, int slot) {
+    struct FileEntry *entry = get_entry(star, slot);
+    printf("%-40s %15zu bytes\n", entry->filename, entry->size);
     
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (star->file_table[i].is_used) {
-            printf("%-40s %15zu bytes\n", 
-                   star->file_table[i].filename, 
-                   star->file_table[i].size);
-            
-            if (star->verbose > 1) {  // Si se usa -vv
-                int block = star->file_table[i].first_block;
-                printf("  Block chain: ");
-                while (block != -1) {
-                    printf("%d -> ", block);
-                    struct Block current_block;
-                    lseek(star->fd, block * sizeof(struct Block), SEEK_SET);
-                    read(star->fd, &current_block, sizeof(struct Block));
-                    block = current_block.next_block;
-                }
-                printf("END\n");
-            }
+    if (star->verbose > 1) {  // Si se usa -vv
+        int block = entry->first_block;
+        printf("  Block chain: ");
+        while (block != -1) {
+            printf("%d -> ", block);
+            int next_block;
+            pread(star->fd, &next_block, sizeof(int), block * sizeof(struct Block));
+            block = next_block;
         }
+        printf("END\n");
     }
 }
 
-// Función mejorada para borrar archivos
-int delete_file(struct StarFile *star, const char *filename) {
-    int file_index = -1;
+// Función para listar el contenido del archivo en orden alfabético. Con
+// patrones, solo se leen del disco las entradas que coinciden
+void list_files(struct StarFile *star, char **patterns, int num_patterns) {
+    printf("Contents of archive:\n");
+    printf("%-40s %15s\n", "Filename", "Size");
+    printf("---------------------------------------- ---------------\n");
     
-    // Buscar el archivo
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (star->file_table[i].is_used && 
-            strcmp(star->file_table[i].filename, filename) == 0) {
-            file_index = i;
-            break;
+    if (num_patterns == 0) {
+        for (int i = 0; i < star->name_index.count; i++) {
+            list_entry(star, star->name_index.slots[i]);
         }
+        return;
     }
     
-    if (file_index == -1) {
-        fprintf(stderr, "File not found: %s\n", filename);
-        return -1;
+    int selected[MAX_FILES];
+    int num_selected;
+    select_files(star, patterns, num_patterns, selected, &num_selected);
+    for (int i = 0; i < num_selected; i++) {
+        list_entry(star, selected[i]);
     }
-    
+}
+
+// Función mejorada para borrar archivos
+int delete_entry(struct StarFile *star, int file_index) {
     // Obtener el primer bloque del archivo
     int current_block = star->file_table[file_index].first_block;
     
@@ -276,22 +773,37 @@ int delete_file(struct StarFile *star, const char *filename) {
     }
     
     // Marcar el archivo como no usado
+    index_remove(star, file_index);
     star->file_table[file_index].is_used = 0;
     star->header.num_files--;
     
-    // Actualizar el header y la tabla de archivos
+    // Actualizar el header, la tabla de archivos y el índice de nombres
     lseek(star->fd, 0, SEEK_SET);
     write(star->fd, &star->header, sizeof(struct StarHeader));
     lseek(star->fd, sizeof(struct StarHeader), SEEK_SET);
     write(star->fd, star->file_table, sizeof(struct FileEntry) * MAX_FILES);
+    write_name_index(star);
     
     if (star->verbose) {
-        printf("Deleted file: %s\n", filename);
+        printf("Deleted file: %s\n", star->file_table[file_index].filename);
     }
     
     return 0;
 }
 
+// Borra los archivos que coinciden con nombres o patrones. La selección se
+// hace completa antes de borrar, para que un patrón no afecte a los demás
+int delete_files(struct StarFile *star, char **patterns, int num_patterns) {
+    int selected[MAX_FILES];
+    int num_selected;
+    int result = select_files(star, patterns, num_patterns, selected, &num_selected);
+    
+    for (int i = 0; i < num_selected; i++) {
+        delete_entry(star, selected[i]);
+    }
+    return result;
+}
+
 // Función para actualizar un archivo
 int update_file(struct StarFile *star, const char *filename) {
     struct stat st;
@@ -357,7 +869,7 @@ int update_file(struct StarFile *star, const char *filename) {
     
     // Si llegamos aquí, necesitamos actualizar el archivo
     // Primero borramos el archivo existente
-    delete_file(star, filename);
+    delete_entry(star, file_index);
     
     // Luego agregamos el nuevo contenido
     return add_file(star, filename);
@@ -497,15 +1009,39 @@ int pack_file(struct StarFile *star) {
     new_header.first_free_block = -1; // No habrá bloques libres después de desfragmentar
     write(temp_fd, &new_header, sizeof(struct StarHeader));
     write(temp_fd, star->file_table, sizeof(struct FileEntry) * MAX_FILES);
+    write(temp_fd, &star->name_index, sizeof(struct NameIndex));
 
-    // Recorrer todos los archivos y reescribirlos de manera contigua
-    int next_block = 0;
-    struct Block block;
-    
+    // Los bloques se escriben por un segundo descriptor, igual que en el original
+    int temp_direct;
+    int temp_data_fd = open_bulk(temp_filename, O_WRONLY, 0, star->direct_io > 0, &temp_direct);
+    if (temp_data_fd == -1) {
+        perror("Error opening temporary file");
+        close(temp_fd);
+        unlink(temp_filename);
+        return -1;
+    }
+    struct Block *block = alloc_block();
+    if (!block) {
+        close(temp_data_fd);
+        close(temp_fd);
+        unlink(temp_filename);
+        return -1;
+    }
+
+    // Recorrer todos los archivos y reescribirlos de manera contigua,
+    // a partir del primer bloque después del header y la tabla
+    off_t metadata_size = NAME_INDEX_OFFSET + sizeof(struct NameIndex);
+    int next_block = (metadata_size + sizeof(struct Block) - 1) / sizeof(struct Block);
+    int old_first_blocks[MAX_FILES];
     for (int i = 0; i < MAX_FILES; i++) {
+        old_first_blocks[i] = star->file_table[i].first_block;
+    }
+    int failed = 0;
+    
+    for (int i = 0; i < MAX_FILES && !failed; i++) {
         if (star->file_table[i].is_used) {
             int old_first_block = star->file_table[i].first_block;
-            star->file_table[i].first_block = next_block;
+            star->file_table[i].first_block = (star->file_table[i].size > 0) ? next_block : -1;
 
             // Copiar todos los bloques del archivo
             int current_block = old_first_block;
@@ -513,29 +1049,51 @@ int pack_file(struct StarFile *star) {
             
             while (current_block != -1 && remaining > 0) {
                 // Leer bloque original
-                lseek(star->fd, current_block * sizeof(struct Block), SEEK_SET);
-                read(star->fd, &block, sizeof(struct Block));
+                if (block_io(star->data_fd, &star->data_direct, star->direct_io,
+                             block, current_block, 0) != sizeof(struct Block)) {
+                    fprintf(stderr, "Error reading block %d\n", current_block);
+                    failed = 1;
+                    break;
+                }
+                int old_next_block = block->next_block;
 
                 // Ajustar el siguiente bloque
-                size_t current_size = (remaining > sizeof(block.data)) ? 
-                                    sizeof(block.data) : remaining;
+                size_t current_size = (remaining > sizeof(block->data)) ? 
+                                    sizeof(block->data) : remaining;
                 
-                if (remaining > sizeof(block.data)) {
-                    block.next_block = next_block + 1;
+                if (remaining > sizeof(block->data)) {
+                    block->next_block = next_block + 1;
                 } else {
-                    block.next_block = -1;
+                    block->next_block = -1;
                 }
 
                 // Escribir bloque en nueva posición
-                lseek(temp_fd, next_block * sizeof(struct Block), SEEK_SET);
-                write(temp_fd, &block, sizeof(struct Block));
+                if (block_io(temp_data_fd, &temp_direct, star->direct_io,
+                             block, next_block, 1) != sizeof(struct Block)) {
+                    fprintf(stderr, "Error writing block %d to temporary file\n", next_block);
+                    failed = 1;
+                    break;
+                }
 
                 remaining -= current_size;
-                current_block = block.next_block;
+                current_block = old_next_block;
                 next_block++;
             }
         }
     }
+    free(block);
+
+    // Si la copia falló, se descarta el temporal y la tabla vuelve a apuntar
+    // a los bloques originales
+    if (failed) {
+        for (int i = 0; i < MAX_FILES; i++) {
+            star->file_table[i].first_block = old_first_blocks[i];
+        }
+        close(temp_data_fd);
+        close(temp_fd);
+        unlink(temp_filename);
+        return -1;
+    }
 
     // Actualizar la tabla de archivos en el archivo temporal
     lseek(temp_fd, sizeof(struct StarHeader), SEEK_SET);
@@ -543,10 +1101,13 @@ int pack_file(struct StarFile *star) {
 
     // Cerrar el archivo original
     close(star->fd);
+    close(star->data_fd);
 
     // Reemplazar el archivo original con el temporal
     rename(temp_filename, "temp.star"); // Primero renombrar a un nombre fijo
     star->fd = temp_fd;
+    star->data_fd = temp_data_fd;
+    star->data_direct = temp_direct;
 
     if (star->verbose) {
         printf("File packed successfully\n");
@@ -560,7 +1121,7 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Usage: %s <options> <archive> [files...]\n", argv[0]);
         fprintf(stderr, "Options:\n");
         fprintf(stderr, "  -c: Create new archive\n");
-        fprintf(stderr, "  -x: Extract files\n");
+        fprintf(stderr, "  -x: Extract files (names, directories or patterns like 'logs/*')\n");
         fprintf(stderr, "  -t, --list: List contents\n");
         fprintf(stderr, "  -u: Update files\n");
         fprintf(stderr, "  -d, --delete: Delete files\n");
@@ -568,11 +1129,13 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "  -p, --pack: Defragment archive\n");
         fprintf(stderr, "  -v: Verbose output\n");
         fprintf(stderr, "  -f: Specify archive file\n");
+        fprintf(stderr, "  -D: Direct I/O on archive (-DD also on source/destination files)\n");
         return 1;
     }
     
     struct StarFile star;
     char verbose = 0;
+    char direct_io = 0;
     char *archive_name = NULL;
     char operation = 0;
     char *append_to = NULL;   
@@ -592,23 +1155,30 @@ int main(int argc, char *argv[]) {
             } else if (strcmp(argv[i], "--pack") == 0 || strcmp(argv[i], "-p") == 0) {
                 operation = 'p';
             } else {
-                for (int j = 1; argv[i][j]; j++) {
+                // Si -r o -f consumen el siguiente argumento, se deja de recorrer
+                // este grupo de opciones para no leer letras del nombre consumido
+                int consumed = 0;
+                for (int j = 1; !consumed && argv[i][j]; j++) {
                     switch (argv[i][j]) {
                         case 'c': operation = 'c'; break;
                         case 'x': operation = 'x'; break;
                         case 't': operation = 't'; break;
                         case 'u': operation = 'u'; break;
+                        case 'd': operation = 'd'; break;
                         case 'r': 
                             operation = 'r';
                             if (i + 1 < argc) {
                                 append_to = argv[++i];
+                                consumed = 1;
                             }
                             break;
                         case 'p': operation = 'p'; break;
                         case 'v': verbose++; break;
+                        case 'D': direct_io++; break;
                         case 'f': 
                             if (i + 1 < argc) {
                                 archive_name = argv[++i];
+                                consumed = 1;
                             }
                             break;
                     }
@@ -623,13 +1193,18 @@ int main(int argc, char *argv[]) {
     }
     
     // Inicializar archivo star
-    init_star_file(&star, archive_name, verbose);
+    init_star_file(&star, archive_name, verbose, direct_io, operation == 'c');
     
-    // Leer la tabla de archivos existente si no estamos creando un nuevo archivo
+    // Leer la tabla de archivos existente si no estamos creando un nuevo archivo.
+    // Para listar basta con el índice: las entradas se leen a medida que se usan
     if (operation != 'c') {
         lseek(star.fd, 0, SEEK_SET);
         read(star.fd, &star.header, sizeof(struct StarHeader));
-        read(star.fd, star.file_table, sizeof(struct FileEntry) * MAX_FILES);
+        star.table_loaded = (operation != 't');
+        if (star.table_loaded) {
+            read(star.fd, star.file_table, sizeof(struct FileEntry) * MAX_FILES);
+        }
+        load_name_index(&star, operation != 't');
     }
     
     switch (operation) {
@@ -643,20 +1218,16 @@ int main(int argc, char *argv[]) {
             if (argc == 3) {
                 extract_all_files(&star);
             } else {
-                for (int i = 3; i < argc; i++) {
-                    extract_file(&star, argv[i]);
-                }
+                extract_files(&star, argv + 3, argc - 3);
             }
             break;
             
         case 't':
-            list_files(&star);
+            list_files(&star, argv + 3, argc - 3);
             break;
             
         case 'd':
-            for (int i = 3; i < argc; i++) {
-                delete_file(&star, argv[i]);
-            }
+            delete_files(&star, argv + 3, argc - 3);
             break;
             
         case 'u':
@@ -669,6 +1240,7 @@ int main(int argc, char *argv[]) {
             if (!append_to) {
                 fprintf(stderr, "Missing destination filename for append operation\n");
                 close(star.fd);
+                close(star.data_fd);
                 return 1;
             }
             // El archivo a agregar será el siguiente argumento después del nombre destino
@@ -689,5 +1261,6 @@ int main(int argc, char *argv[]) {
     }
     
     close(star.fd);
+    close(star.data_fd);
     return 0;
 }
\ No newline at end of file